@@ -1,3 +1,4 @@
+#define _GNU_SOURCE /* fallocate, sync_file_range and O_DIRECT */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +10,26 @@
 #include <unistd.h>
 #include <time.h>
 #include <getopt.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * io_uring executor is built with 5.17+ kernel headers (detected via IORING_FEAT_CQE_SKIP);
+ * uring_probe_ops() checks at runtime that the kernel supports the opcodes (5.15+)
+ */
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_FEAT_CQE_SKIP
+#define HAVE_IO_URING 1
+#endif
+#endif
 
 /* Program constants */
 #define MAX_PATH 1024
@@ -18,6 +39,23 @@
 #define DEFAULT_LOG_FILE "renamed_log.txt"
 #define MAX_PATTERN_LENGTH 256
 
+/* Copy tuning: O_DIRECT needs buffers, offsets and lengths aligned to the block size */
+#define COPY_BUFFER_SIZE (1024 * 1024)
+#define COPY_ALIGNMENT 4096
+#define COPY_FLUSH_INTERVAL (8 * 1024 * 1024) /* Drop copied pages from cache every 8 MB */
+#define URING_QUEUE_DEPTH 64 /* Operations in flight per io_uring batch */
+#define FOLDER_CACHE_SIZE 16 /* Folder scans kept warm in --serve mode */
+#define MAX_REQUEST_ARGS 8 /* Tab-separated fields per --serve request */
+
+/* I/O priority values for ioprio_set(), which glibc doesn't wrap */
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_IDLE 3
+#define IOPRIO_WHO_PROCESS 1
+
+#ifndef O_DIRECT
+#define O_DIRECT 0 /* Not available on this platform, --direct-io becomes a no-op */
+#endif
+
 /* File entry structure to store file information */
 typedef struct {
     char original_name[MAX_PATH];
@@ -33,11 +71,32 @@ typedef struct {
     int dry_run;         /* Dry run mode - don't actually rename files */
     int use_log;         /* Create log file */
     int use_custom_pattern; /* Use custom regex pattern */
+    int direct_io;       /* Bypass the page cache when copying */
+    int use_uring;       /* Apply renames/copies through the io_uring executor */
+    int serve_mode;      /* Run as a Unix socket server */
+    int client_mode;     /* Send one request to a running server */
+    int idle_priority;   /* Run the apply phase at idle I/O and CPU priority */
+    unsigned long long max_bandwidth; /* Bytes per second during apply, 0 = unlimited */
+    unsigned long max_iops;           /* Operations per second during apply, 0 = unlimited */
     char output_path[MAX_PATH]; /* Custom output path */
     char log_file[MAX_PATH];    /* Log file path */
     char custom_pattern[MAX_PATTERN_LENGTH]; /* Custom regex pattern */
+    char socket_path[MAX_PATH]; /* Unix socket for --serve/--client */
 } ProgramConfig;
 
+/* Token bucket limiting the bytes and operations issued during the apply phase */
+typedef struct {
+    double max_bandwidth;       /* Bytes per second, 0 = unlimited */
+    double max_iops;            /* Operations per second, 0 = unlimited */
+    double byte_tokens;
+    double op_tokens;
+    struct timespec last_refill;
+    struct timespec started;
+    double throttled_seconds;   /* Total time spent sleeping on the limits */
+    unsigned long long bytes;   /* Total bytes transferred */
+    unsigned long long ops;     /* Total operations issued */
+} IoThrottle;
+
 /* Get file extension from filename */
 const char *get_file_extension(const char *filename) {
     const char *dot = strrchr(filename, '.');
@@ -45,49 +104,93 @@ const char *get_file_extension(const char *filename) {
     return dot;
 }
 
+/* Patterns to identify special episodes */
+const char *special_patterns[] = {
+    "[Ss]pecial",
+    "SP[0-9]+",
+    "OVA",
+    "Extra",
+    "Bonus"
+};
+#define SPECIAL_PATTERN_COUNT (sizeof(special_patterns) / sizeof(special_patterns[0]))
+
+/* Common episode number patterns */
+const char *episode_patterns[] = {
+    "Episode[ ]*([0-9]{1,3})",         /* Episode 1, Episode 12 */
+    "Ep[ ]*([0-9]{1,3})",              /* Ep 1, Ep12 */
+    "E([0-9]{1,3})([^0-9]|$)",         /* E01, E12 */
+    "-[ ]*([0-9]{1,3})([^0-9]|$)",     /* - 01, -12 */
+    "S[0-9]+[ ]*-[ ]*([0-9]{1,3})",    /* S2 - 10 */
+    "S[0-9]+[ ]+([0-9]{1,3})",         /* S2 08 */
+    "SP[ ]*([0-9]{1,3})",              /* SP01, SP 3 (for specials) */
+    " ([0-9]{1,2})[^0-9]"              /* Fallback: isolated numbers */
+};
+#define EPISODE_PATTERN_COUNT (sizeof(episode_patterns) / sizeof(episode_patterns[0]))
+
+/* Built-in patterns are compiled once and shared by every scan (and every --serve client) */
+regex_t special_regexes[SPECIAL_PATTERN_COUNT];
+int special_regex_ok[SPECIAL_PATTERN_COUNT];
+regex_t episode_regexes[EPISODE_PATTERN_COUNT];
+int episode_regex_ok[EPISODE_PATTERN_COUNT];
+pthread_once_t builtin_patterns_once = PTHREAD_ONCE_INIT;
+
+/* The --pattern value is fixed for the whole process, so it is compiled once as well */
+const char *custom_pattern_source = "";
+regex_t custom_regex;
+int custom_regex_ok;
+pthread_once_t custom_pattern_once = PTHREAD_ONCE_INIT;
+
+/* Compile the built-in special and episode patterns */
+void compile_builtin_patterns(void) {
+    for (int i = 0; i < SPECIAL_PATTERN_COUNT; i++) {
+        special_regex_ok[i] = regcomp(&special_regexes[i], special_patterns[i], REG_EXTENDED | REG_ICASE) == 0;
+    }
+    for (int i = 0; i < EPISODE_PATTERN_COUNT; i++) {
+        episode_regex_ok[i] = regcomp(&episode_regexes[i], episode_patterns[i], REG_EXTENDED) == 0;
+    }
+}
+
+/* Compile the custom pattern set by set_custom_pattern() */
+void compile_custom_pattern(void) {
+    custom_regex_ok = regcomp(&custom_regex, custom_pattern_source, REG_EXTENDED) == 0;
+}
+
+/* Select the custom pattern; must be called before any extraction or thread starts */
+void set_custom_pattern(const char *pattern) {
+    custom_pattern_source = pattern;
+}
+
+/* Compile the custom pattern if needed; returns 0 if it is invalid */
+int custom_pattern_valid(void) {
+    pthread_once(&custom_pattern_once, compile_custom_pattern);
+    return custom_regex_ok;
+}
+
 /* Check if the file is a special episode based on filename patterns */
 int is_special_episode(const char *filename) {
-    regex_t regex;
-    int result = 0;
-    
-    /* Patterns to identify special episodes */
-    const char *patterns[] = {
-        "[Ss]pecial",
-        "SP[0-9]+",
-        "OVA",
-        "Extra",
-        "Bonus"
-    };
-    
-    for (int i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
-        if (regcomp(&regex, patterns[i], REG_EXTENDED | REG_ICASE) != 0) {
-            continue;
-        }
-        
-        if (regexec(&regex, filename, 0, NULL, 0) == 0) {
-            result = 1;
-            regfree(&regex);
-            break;
+    pthread_once(&builtin_patterns_once, compile_builtin_patterns);
+
+    for (int i = 0; i < SPECIAL_PATTERN_COUNT; i++) {
+        if (special_regex_ok[i] && regexec(&special_regexes[i], filename, 0, NULL, 0) == 0) {
+            return 1;
         }
-        regfree(&regex);
     }
     
-    return result;
+    return 0;
 }
 
 /* Extract episode number using a custom pattern */
-int extract_episode_number_custom(const char *filename, const char *pattern) {
-    regex_t regex;
+int extract_episode_number_custom(const char *filename) {
     regmatch_t matches[3]; /* Up to 2 capture groups + the full match */
     char episode_str[10] = {0};
     int episode_num = 0;
 
-    if (regcomp(&regex, pattern, REG_EXTENDED) != 0) {
-        printf("Error compiling custom pattern: %s\n", pattern);
+    if (!custom_pattern_valid()) {
+        printf("Error compiling custom pattern: %s\n", custom_pattern_source);
         return 0;
     }
 
-    if (regexec(&regex, filename, 3, matches, 0) == 0) {
+    if (regexec(&custom_regex, filename, 3, matches, 0) == 0) {
         /* If we have two capture groups, assume it's Season-Episode format */
         if (matches[2].rm_so != -1) {
             int length = matches[2].rm_eo - matches[2].rm_so;
@@ -108,179 +211,1464 @@ int extract_episode_number_custom(const char *filename, const char *pattern) {
         }
     }
 
-    regfree(&regex);
-    return episode_num;
+    return episode_num;
+}
+
+/* Extract episode number from various filename formats */
+int extract_episode_number(const char *filename) {
+    regmatch_t matches[2];
+    char episode_str[10] = {0};
+
+    pthread_once(&builtin_patterns_once, compile_builtin_patterns);
+
+    /* Try each pattern until we find a match */
+    for (int i = 0; i < EPISODE_PATTERN_COUNT; i++) {
+        if (!episode_regex_ok[i]) {
+            continue;
+        }
+
+        if (regexec(&episode_regexes[i], filename, 2, matches, 0) == 0) {
+            int length = matches[1].rm_eo - matches[1].rm_so;
+            if (length < sizeof(episode_str)) {
+                strncpy(episode_str, filename + matches[1].rm_so, length);
+                episode_str[length] = '\0';
+
+                /* Pad single digits with leading zero */
+                if (strlen(episode_str) == 1) {
+                    char padded_episode_str[3] = {'0', episode_str[0], '\0'};
+                    return atoi(padded_episode_str);
+                }
+                return atoi(episode_str);
+            }
+        }
+    }
+    
+    /* Fallback: look for isolated 2-digit numbers */
+    for (size_t i = 0; i < strlen(filename) - 1; i++) {
+        if (isdigit(filename[i]) && isdigit(filename[i + 1])) {
+            /* Make sure it's not part of a larger number */
+            if ((i == 0 || !isdigit(filename[i - 1])) &&
+                (i + 2 >= strlen(filename) || !isdigit(filename[i + 2]))) {
+                char num[3] = {filename[i], filename[i + 1], '\0'};
+                return atoi(num);
+            }
+        }
+    }
+    return 0; /* No episode number found */
+}
+
+/* Create directory if it doesn't exist, reporting errors to out */
+int create_directory(const char *path, FILE *out) {
+    struct stat st = {0};
+    if (stat(path, &st) == -1) {
+        #ifdef _WIN32
+        if (mkdir(path) != 0) {
+            fprintf(out, "Error creating directory '%s': %s\n", path, strerror(errno));
+            return 0;
+        }
+        #else
+        if (mkdir(path, 0755) != 0) {
+            fprintf(out, "Error creating directory '%s': %s\n", path, strerror(errno));
+            return 0;
+        }
+        #endif
+        return 1;
+    }
+    return 1; /* Directory already exists */
+}
+
+/* Seconds elapsed between two monotonic timestamps */
+double elapsed_seconds(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Set up a throttle; a zero limit leaves that dimension unlimited */
+void throttle_init(IoThrottle *throttle, unsigned long long max_bandwidth, unsigned long max_iops) {
+    memset(throttle, 0, sizeof(*throttle));
+    throttle->max_bandwidth = (double)max_bandwidth;
+    throttle->max_iops = (double)max_iops;
+    /* Start with a full bucket so the first second isn't delayed */
+    throttle->byte_tokens = throttle->max_bandwidth;
+    throttle->op_tokens = throttle->max_iops;
+    clock_gettime(CLOCK_MONOTONIC, &throttle->started);
+    throttle->last_refill = throttle->started;
+}
+
+/* Top up both buckets for the time elapsed, capped at one second of burst */
+void throttle_refill(IoThrottle *throttle) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = elapsed_seconds(&throttle->last_refill, &now);
+    throttle->last_refill = now;
+
+    throttle->byte_tokens += elapsed * throttle->max_bandwidth;
+    if (throttle->byte_tokens > throttle->max_bandwidth) {
+        throttle->byte_tokens = throttle->max_bandwidth;
+    }
+    throttle->op_tokens += elapsed * throttle->max_iops;
+    if (throttle->op_tokens > throttle->max_iops) {
+        throttle->op_tokens = throttle->max_iops;
+    }
+}
+
+/* Account for an I/O and sleep until the buckets are out of debt */
+void throttle_consume(IoThrottle *throttle, size_t bytes, int ops) {
+    double wait = 0;
+
+    if (!throttle) return;
+    throttle->bytes += bytes;
+    throttle->ops += ops;
+    if (throttle->max_bandwidth <= 0 && throttle->max_iops <= 0) return;
+
+    throttle_refill(throttle);
+    if (throttle->max_bandwidth > 0) {
+        throttle->byte_tokens -= bytes;
+        if (throttle->byte_tokens < 0) {
+            wait = -throttle->byte_tokens / throttle->max_bandwidth;
+        }
+    }
+    if (throttle->max_iops > 0) {
+        throttle->op_tokens -= ops;
+        if (throttle->op_tokens < 0 && -throttle->op_tokens / throttle->max_iops > wait) {
+            wait = -throttle->op_tokens / throttle->max_iops;
+        }
+    }
+
+    if (wait > 0) {
+        struct timespec delay;
+        delay.tv_sec = (time_t)wait;
+        delay.tv_nsec = (long)((wait - delay.tv_sec) * 1e9);
+        while (nanosleep(&delay, &delay) != 0 && errno == EINTR);
+        throttle->throttled_seconds += wait;
+    }
+}
+
+/* Parse a byte rate like "500K", "20M" or "1G" (binary units); returns 0 if invalid */
+unsigned long long parse_rate(const char *text) {
+    char *end;
+    unsigned long long value;
+
+    /* strtoull would accept leading blanks and a minus sign */
+    if (!isdigit((unsigned char)*text)) return 0;
+    value = strtoull(text, &end, 10);
+    switch (toupper((unsigned char)*end)) {
+        case 'K': value *= 1024ULL; end++; break;
+        case 'M': value *= 1024ULL * 1024; end++; break;
+        case 'G': value *= 1024ULL * 1024 * 1024; end++; break;
+    }
+    /* Allow an optional "B" or "B/s" suffix */
+    if (toupper((unsigned char)*end) == 'B') end++;
+    if (strcmp(end, "/s") == 0) end += 2;
+    return *end == '\0' ? value : 0;
+}
+
+/* Parse a plain positive integer like "200"; returns 0 if invalid */
+unsigned long parse_count(const char *text) {
+    char *end;
+    unsigned long value;
+
+    if (!isdigit((unsigned char)*text)) return 0;
+    value = strtoul(text, &end, 10);
+    return *end == '\0' ? value : 0;
+}
+
+/* Drop to idle I/O scheduling class and lowest CPU priority */
+void enter_idle_priority(FILE *log_fp, FILE *out) {
+    #ifdef SYS_ioprio_set
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0) {
+        fprintf(out, "Warning: Could not set idle I/O priority: %s\n", strerror(errno));
+        if (log_fp) {
+            fprintf(log_fp, "[WARNING] Could not set idle I/O priority: %s\n", strerror(errno));
+        }
+    }
+    #endif
+    if (setpriority(PRIO_PROCESS, 0, 19) != 0) {
+        fprintf(out, "Warning: Could not lower CPU priority: %s\n", strerror(errno));
+        if (log_fp) {
+            fprintf(log_fp, "[WARNING] Could not lower CPU priority: %s\n", strerror(errno));
+        }
+    }
+}
+
+/* Write a whole buffer, retrying on short writes */
+int write_all(int fd, const char *buffer, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, buffer, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        buffer += written;
+        length -= written;
+    }
+    return 1;
+}
+
+/* Start writeback of a freshly copied range without waiting for it */
+void start_writeback(int dst, off_t offset, off_t length) {
+    #ifdef SYNC_FILE_RANGE_WRITE
+    sync_file_range(dst, offset, length, SYNC_FILE_RANGE_WRITE);
+    #endif
+}
+
+/* Wait for a copied range to reach disk and drop it from the page cache on both ends */
+void release_copied_range(int src, int dst, off_t offset, off_t length) {
+    #ifdef SYNC_FILE_RANGE_WRITE
+    sync_file_range(dst, offset, length,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    #else
+    fdatasync(dst);
+    #endif
+    posix_fadvise(dst, offset, length, POSIX_FADV_DONTNEED);
+    posix_fadvise(src, offset, length, POSIX_FADV_DONTNEED);
+}
+
+/* Open a file for copying, falling back to buffered I/O if O_DIRECT is refused */
+int open_for_copy(const char *path, int flags, int *direct_io) {
+    int fd = open(path, flags | (*direct_io ? O_DIRECT : 0), 0666);
+    if (fd < 0 && *direct_io && errno == EINVAL) {
+        /* Filesystem doesn't support O_DIRECT (e.g. tmpfs) */
+        *direct_io = 0;
+        fd = open(path, flags, 0666);
+    }
+    return fd;
+}
+
+/* Turn off O_DIRECT on an open descriptor (needed for unaligned tails) */
+void disable_direct_io(int fd, int *direct_io) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags != -1) {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+    *direct_io = 0;
+}
+
+/* Copy between two open descriptors without flooding the page cache; closes both and reports errors to out */
+int copy_file_fds(int src, int dst, int src_direct, int dst_direct,
+                  const char *source, const char *destination, IoThrottle *throttle, FILE *out) {
+    struct stat st;
+    void *buffer;
+    ssize_t bytes_read;
+    off_t copied = 0;
+    off_t window_start = 0;     /* Start of the range not yet handed to writeback */
+    off_t released = 0;         /* Everything before this has been dropped from the cache */
+    off_t reserved = 0;         /* Bytes preallocated past EOF by fallocate() */
+    int success = 1;
+
+    if (posix_memalign(&buffer, COPY_ALIGNMENT, COPY_BUFFER_SIZE) != 0) {
+        fprintf(out, "Error allocating copy buffer for '%s'\n", source);
+        close(src);
+        close(dst);
+        return 0;
+    }
+
+    /* Reserve the whole destination up front so it isn't grown (and fragmented) chunk by chunk */
+    if (fstat(src, &st) == 0 && st.st_size > 0) {
+        #ifdef FALLOC_FL_KEEP_SIZE
+        /* Best effort, not all filesystems support it */
+        if (fallocate(dst, FALLOC_FL_KEEP_SIZE, 0, st.st_size) == 0) {
+            reserved = st.st_size;
+        }
+        #endif
+    }
+    posix_fadvise(src, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    while (1) {
+        bytes_read = read(src, buffer, COPY_BUFFER_SIZE);
+        if (bytes_read < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EINVAL && src_direct) {
+                /* Unaligned offset after a short read, finish with buffered reads */
+                disable_direct_io(src, &src_direct);
+                continue;
+            }
+            fprintf(out, "Error reading source file '%s': %s\n", source, strerror(errno));
+            success = 0;
+            break;
+        }
+        if (bytes_read == 0) break;
+
+        /* One read plus one write per chunk */
+        throttle_consume(throttle, bytes_read, 2);
+
+        /* O_DIRECT can't write a partial block, so the tail goes through the page cache */
+        if (dst_direct && bytes_read % COPY_ALIGNMENT != 0) {
+            disable_direct_io(dst, &dst_direct);
+        }
+
+        if (!write_all(dst, buffer, bytes_read)) {
+            fprintf(out, "Error writing to destination file '%s': %s\n", destination, strerror(errno));
+            success = 0;
+            break;
+        }
+        copied += bytes_read;
+
+        /* Write-behind: kick off the window just written, then wait on and drop the one before it */
+        if (copied - window_start >= COPY_FLUSH_INTERVAL) {
+            start_writeback(dst, window_start, copied - window_start);
+            if (window_start > released) {
+                release_copied_range(src, dst, released, window_start - released);
+                released = window_start;
+            }
+            window_start = copied;
+        }
+    }
+
+    if (success && copied > released) {
+        release_copied_range(src, dst, released, copied - released);
+    }
+
+    /*
+     * A failed copy (or a source that shrank) must not keep the unused reservation
+     * allocated; truncating frees blocks past EOF (a punched hole there is ignored by ext4)
+     */
+    if (reserved > copied) {
+        ftruncate(dst, copied);
+    }
+
+    free(buffer);
+    close(src);
+    if (close(dst) != 0 && success) {
+        fprintf(out, "Error writing to destination file '%s': %s\n", destination, strerror(errno));
+        success = 0;
+    }
+    return success;
+}
+
+/* Copy a file from source to destination, reporting errors to out */
+int copy_file(const char *source, const char *destination, int direct_io, IoThrottle *throttle, FILE *out) {
+    int src, dst;
+    int src_direct = direct_io, dst_direct = direct_io;
+
+    src = open_for_copy(source, O_RDONLY, &src_direct);
+    if (src < 0) {
+        fprintf(out, "Error opening source file '%s': %s\n", source, strerror(errno));
+        return 0;
+    }
+
+    dst = open_for_copy(destination, O_WRONLY | O_CREAT | O_TRUNC, &dst_direct);
+    if (dst < 0) {
+        fprintf(out, "Error opening destination file '%s': %s\n", destination, strerror(errno));
+        close(src);
+        return 0;
+    }
+
+    return copy_file_fds(src, dst, src_direct, dst_direct, source, destination, throttle, out);
+}
+
+/* Build the source and target paths for a planned file */
+void build_apply_paths(const FileEntry *file, const char *folder_path, const char *destination_path,
+                       const char *specials_path, char *old_path, char *new_path) {
+    snprintf(old_path, MAX_PATH, "%s/%s", folder_path, file->original_name);
+    snprintf(new_path, MAX_PATH, "%s/%s",
+             file->is_special ? specials_path : destination_path, file->new_name);
+}
+
+#ifdef HAVE_IO_URING
+/* Minimal io_uring submission/completion queue, set up with raw syscalls (no liburing needed) */
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned pending;           /* SQEs queued but not yet submitted */
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+} UringQueue;
+
+/* Check that the kernel supports every opcode the executor needs */
+int uring_probe_ops(int ring_fd) {
+    const int needed[] = { IORING_OP_RENAMEAT, IORING_OP_MKDIRAT, IORING_OP_OPENAT };
+    size_t probe_size = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, probe_size);
+    int supported = 1;
+
+    if (!probe) return 0;
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+        free(probe);
+        return 0;
+    }
+    for (int i = 0; i < sizeof(needed) / sizeof(needed[0]); i++) {
+        if (needed[i] > probe->last_op || !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED)) {
+            supported = 0;
+        }
+    }
+    free(probe);
+    return supported;
+}
+
+/* Set up a ring; returns 0 on success or an errno value */
+int uring_open(UringQueue *ring, unsigned entries) {
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return errno;
+
+    if (!uring_probe_ops(ring->fd)) {
+        close(ring->fd);
+        return EOPNOTSUPP;
+    }
+
+    ring->entries = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        int error = errno;
+        if (ring->sq_ring != MAP_FAILED) munmap(ring->sq_ring, ring->sq_ring_size);
+        if (ring->cq_ring != MAP_FAILED) munmap(ring->cq_ring, ring->cq_ring_size);
+        if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        close(ring->fd);
+        return error;
+    }
+
+    ring->sq_head = (unsigned *)((char *)ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (unsigned *)((char *)ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)((char *)ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)((char *)ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned *)((char *)ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned *)((char *)ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)((char *)ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)((char *)ring->cq_ring + params.cq_off.cqes);
+    return 0;
+}
+
+/* Tear down a ring set up by uring_open() */
+void uring_close(UringQueue *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    munmap(ring->cq_ring, ring->cq_ring_size);
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+/* Grab a zeroed SQE tagged with user_data, or NULL if the queue is full */
+struct io_uring_sqe *uring_get_sqe(UringQueue *ring, unsigned long long user_data) {
+    unsigned tail = *ring->sq_tail + ring->pending;
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    struct io_uring_sqe *sqe;
+
+    if (tail - head >= ring->entries) return NULL;
+    sqe = &ring->sqes[tail & *ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    ring->sq_array[tail & *ring->sq_mask] = tail & *ring->sq_mask;
+    ring->pending++;
+    return sqe;
+}
+
+/* Submit all queued SQEs, wait for them and store each result by user_data; returns 0 or an errno */
+int uring_run(UringQueue *ring, int *results) {
+    unsigned to_submit = ring->pending;
+    unsigned completed = 0;
+
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + ring->pending, __ATOMIC_RELEASE);
+    ring->pending = 0;
+
+    while (completed < to_submit) {
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+        if (head == tail) {
+            /* Nothing reaped yet: submit whatever is left and wait for at least one completion */
+            unsigned sq_left = *ring->sq_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+            if (syscall(__NR_io_uring_enter, ring->fd, sq_left, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+                errno != EINTR) {
+                return errno;
+            }
+            continue;
+        }
+
+        for (; head != tail; head++, completed++) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            results[cqe->user_data] = cqe->res;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/* Create a directory with IORING_OP_MKDIRAT; an existing directory counts as success */
+int uring_create_directory(UringQueue *ring, const char *path, FILE *out) {
+    int result = 0;
+    struct io_uring_sqe *sqe = uring_get_sqe(ring, 0);
+
+    sqe->opcode = IORING_OP_MKDIRAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (unsigned long long)(uintptr_t)path;
+    sqe->len = 0755;
+    if (uring_run(ring, &result) != 0 || (result < 0 && result != -EEXIST)) {
+        fprintf(out, "Error creating directory '%s': %s\n", path, strerror(result < 0 ? -result : errno));
+        return 0;
+    }
+    return 1;
+}
+
+/* Queue an IORING_OP_OPENAT for path */
+void uring_prep_openat(struct io_uring_sqe *sqe, const char *path, int flags) {
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (unsigned long long)(uintptr_t)path;
+    sqe->len = 0666;
+    sqe->open_flags = flags;
+}
+
+/* Open a single file through the ring; returns the descriptor or -errno */
+int uring_open_file(UringQueue *ring, const char *path, int flags) {
+    int result = -ECANCELED;
+    int error;
+
+    uring_prep_openat(uring_get_sqe(ring, 0), path, flags);
+    error = uring_run(ring, &result);
+    return error ? -error : result;
+}
+
+/*
+ * Rename or copy every planned file through the ring in batches, so many
+ * metadata operations are in flight at once. results[i] receives 0 on
+ * success or an errno value. Copies batch only the source opens; each
+ * destination is opened just before its data moves, so an interrupted run
+ * leaves at most one partial file, like the synchronous path. The data
+ * itself goes through copy_file_fds(), keeping throttling and page-cache
+ * hints identical to the synchronous path.
+ */
+int uring_apply_files(UringQueue *ring, const FileEntry *files, int file_count,
+                      const char *folder_path, const char *destination_path, const char *specials_path,
+                      const ProgramConfig *config, IoThrottle *throttle, int *results, FILE *out) {
+    int batch_size = ring->entries;
+    char (*old_paths)[MAX_PATH] = malloc(batch_size * sizeof(*old_paths));
+    char (*new_paths)[MAX_PATH] = malloc(batch_size * sizeof(*new_paths));
+    int *batch_results = malloc(batch_size * sizeof(int));
+    int direct_flag = config->direct_io ? O_DIRECT : 0;
+    int error = 0;
+
+    if (!old_paths || !new_paths || !batch_results) {
+        free(old_paths);
+        free(new_paths);
+        free(batch_results);
+        return ENOMEM;
+    }
+
+    for (int start = 0; start < file_count && !error; start += batch_size) {
+        int count = file_count - start < batch_size ? file_count - start : batch_size;
+
+        for (int j = 0; j < count; j++) {
+            struct io_uring_sqe *sqe = uring_get_sqe(ring, j);
+
+            build_apply_paths(&files[start + j], folder_path, destination_path, specials_path,
+                              old_paths[j], new_paths[j]);
+            /* Anything the ring never completes keeps this value */
+            batch_results[j] = -ECANCELED;
+            if (config->keep_originals) {
+                uring_prep_openat(sqe, old_paths[j], O_RDONLY | direct_flag);
+            } else {
+                throttle_consume(throttle, 0, 1);
+                sqe->opcode = IORING_OP_RENAMEAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = (unsigned long long)(uintptr_t)old_paths[j];
+                sqe->len = AT_FDCWD;
+                sqe->addr2 = (unsigned long long)(uintptr_t)new_paths[j];
+            }
+        }
+
+        error = uring_run(ring, batch_results);
+        if (error) {
+            /* Keep the results that did complete and release any source already opened */
+            for (int j = 0; j < count; j++) {
+                if (config->keep_originals) {
+                    if (batch_results[j] >= 0) close(batch_results[j]);
+                } else if (batch_results[j] != -ECANCELED) {
+                    results[start + j] = batch_results[j] < 0 ? -batch_results[j] : 0;
+                }
+            }
+            break;
+        }
+
+        for (int j = 0; j < count; j++) {
+            if (!config->keep_originals) {
+                results[start + j] = batch_results[j] < 0 ? -batch_results[j] : 0;
+                continue;
+            }
+
+            int src = batch_results[j], dst;
+            int src_direct = config->direct_io, dst_direct = config->direct_io;
+
+            /* Filesystems without O_DIRECT support are retried buffered, like open_for_copy() */
+            if (src == -EINVAL && src_direct) {
+                src_direct = 0;
+                src = open(old_paths[j], O_RDONLY);
+                if (src < 0) src = -errno;
+            }
+            if (src < 0) {
+                fprintf(out, "Error opening source file '%s': %s\n", old_paths[j], strerror(-src));
+                results[start + j] = -src;
+                continue;
+            }
+
+            dst = uring_open_file(ring, new_paths[j], O_WRONLY | O_CREAT | O_TRUNC | direct_flag);
+            if (dst == -EINVAL && dst_direct) {
+                dst_direct = 0;
+                dst = open(new_paths[j], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+                if (dst < 0) dst = -errno;
+            }
+            if (dst < 0) {
+                fprintf(out, "Error opening destination file '%s': %s\n", new_paths[j], strerror(-dst));
+                close(src);
+                results[start + j] = -dst;
+                continue;
+            }
+
+            results[start + j] = copy_file_fds(src, dst, src_direct, dst_direct,
+                                               old_paths[j], new_paths[j], throttle, out) ? 0 : EIO;
+        }
+    }
+
+    free(old_paths);
+    free(new_paths);
+    free(batch_results);
+    return error;
+}
+#else
+/* Placeholder so the executor selection compiles where io_uring isn't available */
+typedef struct {
+    int fd;
+} UringQueue;
+
+int uring_open(UringQueue *ring, unsigned entries) {
+    return ENOSYS;
+}
+
+void uring_close(UringQueue *ring) {
+}
+
+int uring_create_directory(UringQueue *ring, const char *path, FILE *out) {
+    return create_directory(path, out);
+}
+
+int uring_apply_files(UringQueue *ring, const FileEntry *files, int file_count,
+                      const char *folder_path, const char *destination_path, const char *specials_path,
+                      const ProgramConfig *config, IoThrottle *throttle, int *results, FILE *out) {
+    return ENOSYS;
+}
+#endif
+
+/* Log operation to file */
+void log_operation(FILE *log_file, const char *action, const char *old_path, const char *new_path, int success) {
+    time_t now;
+    struct tm *timeinfo;
+    char timestamp[20];
+    
+    time(&now);
+    timeinfo = localtime(&now);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", timeinfo);
+    
+    fprintf(log_file, "[%s] %s: %s -> %s [%s]\n", 
+            timestamp, 
+            action, 
+            old_path, 
+            new_path, 
+            success ? "SUCCESS" : "FAILED");
+}
+
+/* Compare function for sorting files */
+int compare_files(const void *a, const void *b) {
+    FileEntry *fileA = (FileEntry *)a;
+    FileEntry *fileB = (FileEntry *)b;
+    
+    /* Group regular episodes before specials */
+    if (fileA->is_special != fileB->is_special) {
+        return fileA->is_special - fileB->is_special;
+    }
+    
+    /* Sort by episode number */
+    return fileA->episode_number - fileB->episode_number;
+}
+
+/* Display version information */
+void print_version() {
+    printf("ReNamed - Automatic Episode Renamer v%s\n", VERSION);
+    printf("Repository: %s\n", REPO_URL);
+    printf("\nA simple tool to rename and organize TV show episodes.\n");
+}
+
+/* Display usage information */
+void print_usage(char *program_name) {
+    printf("Usage: %s [OPTIONS]\n\n", program_name);
+    printf("Options:\n");
+    printf("  -v           Display version information\n");
+    printf("  -h           Display this help message\n");
+    printf("  -f           Force renaming of all file types (not just video files)\n");
+    printf("  -k           Keep original files\n");
+    printf("  -d           Dry run mode (only show what would happen, don't rename files)\n");
+    printf("  -p <path>    Specify custom output path for renamed files\n");
+    printf("  --log[=file] Create log file (default: renamed_log.txt)\n");
+    printf("  --pattern=<regex> Specify custom regex pattern for episode detection\n");
+    printf("               Example: --pattern='Season (\\d+)-Episode (\\d+)'\n");
+    printf("  --direct-io  Bypass the page cache when copying (with -k)\n");
+    printf("  --max-bandwidth=<rate> Limit copy throughput, e.g. 50M (bytes/s, K/M/G suffixes)\n");
+    printf("  --max-iops=<n> Limit file operations per second\n");
+    printf("  --idle       Run renaming/copying at idle I/O and CPU priority\n");
+    printf("  --executor=<sync|uring> Issue renames/copies one by one (default) or batched via io_uring\n");
+    printf("  --serve      Run as a server on a Unix socket, keeping patterns and folder scans cached\n");
+    printf("  --client COMMAND [ARGS...] Send one request to a running server; must be the last option,\n");
+    printf("               everything after it is sent as-is (even arguments starting with '-'), e.g.\n");
+    printf("               --client APPLY 'Show Name' /path/to/folder '' 'Show E01.mkv'\n");
+    printf("  --socket=<path> Socket for --serve/--client (default: $XDG_RUNTIME_DIR/renamed.sock,\n");
+    printf("               or /tmp/renamed-<uid>/renamed.sock)\n\n");
+    printf("If no options are provided, the program runs in interactive mode.\n");
+}
+
+/* Check if a file is a video file */
+int is_video_file(const char *extension) {
+    return (strcasecmp(extension, ".mp4") == 0 ||
+            strcasecmp(extension, ".mkv") == 0 ||
+            strcasecmp(extension, ".avi") == 0);
+}
+
+/* Classify one file in a folder into entry, warning on out; returns 1 if it is a usable episode, 0 if it is skipped */
+int classify_file(const char *folder_path, const char *name, const ProgramConfig *config, FileEntry *entry, FILE *log_fp, FILE *out) {
+    /* Skip directories */
+    char full_path[MAX_PATH];
+    snprintf(full_path, sizeof(full_path), "%s/%s", folder_path, name);
+
+    struct stat path_stat;
+    if (stat(full_path, &path_stat) != 0) {
+        fprintf(out, "Warning: Cannot get stats for '%s': %s\n", name, strerror(errno));
+        return 0;
+    }
+    
+    if (!S_ISREG(path_stat.st_mode))
+        return 0;
+
+    /* Get file extension */
+    const char *extension = get_file_extension(name);
+
+    /* Skip non-video files unless force mode is enabled */
+    if (!config->force_mode && !is_video_file(extension))
+        return 0;
+
+    /* Check if this is a special episode */
+    int special = is_special_episode(name);
+    
+    /* Extract episode number using either custom or default patterns */
+    int episode_num;
+    if (config->use_custom_pattern) {
+        episode_num = extract_episode_number_custom(name);
+    } else {
+        episode_num = extract_episode_number(name);
+    }
+
+    if (episode_num == 0) {
+        fprintf(out, "Warning: No episode number found in '%s', skipping.\n", name);
+        if (log_fp) {
+            fprintf(log_fp, "[WARNING] No episode number found in '%s', skipping.\n", name);
+        }
+        return 0;
+    }
+
+    /* Store file information */
+    strcpy(entry->original_name, name);
+    entry->episode_number = episode_num;
+    entry->is_special = special;
+    entry->new_name[0] = '\0';
+
+    return 1;
+}
+
+/* Scan a folder and classify its episodes, warning on out; returns the number of files found, or -1 if it can't be opened */
+int scan_folder(const char *folder_path, const ProgramConfig *config, FileEntry *files, FILE *log_fp, FILE *out) {
+    DIR *dir;
+    struct dirent *entry;
+    int file_count = 0;
+
+    dir = opendir(folder_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    while ((entry = readdir(dir)) != NULL && file_count < MAX_FILES) {
+        /* Skip . and .. directories */
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        if (classify_file(folder_path, entry->d_name, config, &files[file_count], log_fp, out)) {
+            file_count++;
+        }
+    }
+
+    closedir(dir);
+    return file_count;
+}
+
+/* Generate new filenames for scanned files based on type */
+void assign_new_names(FileEntry *files, int file_count, const char *show_name) {
+    for (int i = 0; i < file_count; i++) {
+        const char *extension = get_file_extension(files[i].original_name);
+
+        if (files[i].is_special) {
+            snprintf(files[i].new_name, MAX_PATH, "%s - %02d - Special%s",
+                    show_name, files[i].episode_number, extension);
+        } else {
+            snprintf(files[i].new_name, MAX_PATH, "%s - %02d%s",
+                    show_name, files[i].episode_number, extension);
+        }
+    }
+}
+
+/* Totals from one apply pass */
+typedef struct {
+    int success_count;
+    int special_count;
+    int regular_count;
+    IoThrottle throttle;    /* Bytes, operations and throttle time */
+} ApplyStats;
+
+/* Rename or copy every planned file, reporting each operation to out; returns 0 if the destination can't be created */
+int apply_files(const FileEntry *files, int file_count, const char *folder_path,
+                const char *destination_path, const char *specials_path,
+                const ProgramConfig *config, FILE *log_fp, FILE *out, ApplyStats *stats) {
+    int has_special_episodes = 0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    /* Create destination directory if different from source */
+    if (strcmp(folder_path, destination_path) != 0) {
+        if (!create_directory(destination_path, out)) {
+            fprintf(out, "Error: Failed to create destination directory '%s'\n", destination_path);
+            if (log_fp) {
+                fprintf(log_fp, "[ERROR] Failed to create destination directory '%s'\n", destination_path);
+            }
+            return 0;
+        }
+    }
+
+    /* Set up the io_uring executor if requested, falling back to synchronous calls */
+    UringQueue ring;
+    int use_uring = 0;
+    if (config->use_uring) {
+        int error = uring_open(&ring, URING_QUEUE_DEPTH);
+        if (error == 0) {
+            use_uring = 1;
+            if (log_fp) {
+                fprintf(log_fp, "[INFO] Using io_uring executor.\n");
+            }
+        } else {
+            fprintf(out, "Warning: io_uring executor unavailable (%s), using synchronous executor.\n", strerror(error));
+            if (log_fp) {
+                fprintf(log_fp, "[WARNING] io_uring executor unavailable (%s), using synchronous executor.\n",
+                        strerror(error));
+            }
+        }
+    }
+
+    /* Create specials directory only if special episodes exist */
+    for (int i = 0; i < file_count; i++) {
+        if (files[i].is_special) {
+            has_special_episodes = 1;
+            break;
+        }
+    }
+    if (has_special_episodes) {
+        if (use_uring ? uring_create_directory(&ring, specials_path, out) : create_directory(specials_path, out)) {
+            fprintf(out, "Created 'Specials' directory in '%s'.\n", destination_path);
+            if (log_fp) {
+                fprintf(log_fp, "[INFO] Created 'Specials' directory in '%s'.\n", destination_path);
+            }
+        }
+    }
+
+    /* Perform renaming/copying */
+    if (config->idle_priority) {
+        enter_idle_priority(log_fp, out);
+    }
+    throttle_init(&stats->throttle, config->max_bandwidth, config->max_iops);
+
+    /* With io_uring every operation is issued up front; results[i] is 0 or an errno */
+    int *results = NULL;
+    if (use_uring) {
+        results = malloc(file_count * sizeof(int));
+        if (results) {
+            /* Files left unprocessed if the ring fails are reported as cancelled, not retried */
+            for (int i = 0; i < file_count; i++) {
+                results[i] = ECANCELED;
+            }
+            int error = uring_apply_files(&ring, files, file_count, folder_path, destination_path,
+                                          specials_path, config, &stats->throttle, results, out);
+            if (error) {
+                fprintf(out, "Error: io_uring executor failed: %s\n", strerror(error));
+                if (log_fp) {
+                    fprintf(log_fp, "[ERROR] io_uring executor failed: %s\n", strerror(error));
+                }
+            }
+        }
+        uring_close(&ring);
+    }
+
+    for (int i = 0; i < file_count; i++) {
+        char old_path[MAX_PATH];
+        char new_path[MAX_PATH];
+
+        build_apply_paths(&files[i], folder_path, destination_path, specials_path, old_path, new_path);
+        if (files[i].is_special) {
+            stats->special_count++;
+        } else {
+            stats->regular_count++;
+        }
+
+        if (config->keep_originals) {
+            /* Copy the file instead of renaming */
+            int success = results ? results[i] == 0
+                                  : copy_file(old_path, new_path, config->direct_io, &stats->throttle, out);
+            if (success) {
+                stats->success_count++;
+                fprintf(out, "Copied '%s' to '%s'\n", files[i].original_name, new_path);
+                if (log_fp) {
+                    log_operation(log_fp, "COPY", old_path, new_path, 1);
+                }
+            } else {
+                fprintf(out, "Error copying '%s' to '%s'\n", files[i].original_name, new_path);
+                if (log_fp) {
+                    log_operation(log_fp, "COPY", old_path, new_path, 0);
+                }
+            }
+        } else {
+            /* Rename/move the file */
+            int renamed;
+            if (results) {
+                errno = results[i];
+                renamed = results[i] == 0;
+            } else {
+                throttle_consume(&stats->throttle, 0, 1);
+                renamed = rename(old_path, new_path) == 0;
+            }
+            if (renamed) {
+                stats->success_count++;
+                fprintf(out, "Renamed '%s' to '%s'\n", files[i].original_name, files[i].new_name);
+                if (log_fp) {
+                    log_operation(log_fp, "RENAME", old_path, new_path, 1);
+                }
+            } else {
+                fprintf(out, "Error renaming '%s' to '%s': %s\n",
+                        files[i].original_name,
+                        files[i].new_name,
+                        strerror(errno));
+                if (log_fp) {
+                    log_operation(log_fp, "RENAME", old_path, new_path, 0);
+                }
+            }
+        }
+    }
+
+    free(results);
+    return 1;
+}
+
+/* Report throughput and time spent waiting on the rate limits after apply_files, on out and in the log */
+void report_throughput(const ApplyStats *stats, const ProgramConfig *config, const char *prefix, FILE *out, FILE *log_fp) {
+    struct timespec finished;
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double elapsed = elapsed_seconds(&stats->throttle.started, &finished);
+    double mb = stats->throttle.bytes / (1024.0 * 1024.0);
+    double mb_per_second = elapsed > 0 ? mb / elapsed : 0;
+    double ops_per_second = elapsed > 0 ? stats->throttle.ops / elapsed : 0;
+
+    fprintf(out, "%s%.1f MB, %llu operations in %.2f s (%.1f MB/s, %.0f ops/s)",
+            prefix, mb, stats->throttle.ops, elapsed, mb_per_second, ops_per_second);
+    if (config->max_bandwidth || config->max_iops) {
+        fprintf(out, ", %.2f s spent throttled", stats->throttle.throttled_seconds);
+    }
+    fprintf(out, "\n");
+
+    if (log_fp) {
+        fprintf(log_fp, "[INFO] %.1f MB, %llu operations in %.2f s (%.1f MB/s, %.0f ops/s), %.2f s throttled.\n",
+                mb, stats->throttle.ops, elapsed, mb_per_second, ops_per_second, stats->throttle.throttled_seconds);
+    }
+}
+
+/* Cached scan of one folder, reused while the directory's mtime is unchanged */
+typedef struct {
+    char folder[MAX_PATH];
+    struct timespec mtime;
+    FileEntry *files;
+    int file_count;
+    unsigned long last_used;
+} FolderCacheEntry;
+
+FolderCacheEntry folder_cache[FOLDER_CACHE_SIZE];
+unsigned long folder_cache_clock = 0;
+pthread_mutex_t folder_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Serializes APPLY requests so two clients never move the same files at once */
+pthread_mutex_t apply_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Socket path removed again by the signal handler on shutdown */
+char serve_socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+/* Shared state handed to each client thread */
+typedef struct {
+    int fd;
+    const ProgramConfig *config;
+    FILE *log_fp;
+} ClientContext;
+
+/*
+ * Pick the default socket path: $XDG_RUNTIME_DIR/renamed.sock, else
+ * renamed.sock inside a private /tmp/renamed-<uid> directory. The server
+ * creates that directory; both sides refuse it unless it is a real
+ * directory owned by us with mode 0700, so another local user can't plant
+ * a socket there first. Returns 0 on failure.
+ */
+int default_socket_path(char *path, size_t size, int create) {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    char private_dir[MAX_PATH];
+    struct stat st;
+
+    if (runtime_dir && *runtime_dir) {
+        snprintf(path, size, "%s/renamed.sock", runtime_dir);
+        return 1;
+    }
+
+    snprintf(private_dir, sizeof(private_dir), "/tmp/renamed-%d", (int)getuid());
+    if (create && mkdir(private_dir, 0700) != 0 && errno != EEXIST) {
+        printf("Error creating socket directory '%s': %s\n", private_dir, strerror(errno));
+        return 0;
+    }
+    if (lstat(private_dir, &st) != 0) {
+        printf("Error: Cannot access socket directory '%s': %s\n", private_dir, strerror(errno));
+        return 0;
+    }
+    if (!S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 0077) != 0) {
+        printf("Error: Socket directory '%s' is not a private directory owned by you\n", private_dir);
+        return 0;
+    }
+
+    snprintf(path, size, "%s/renamed.sock", private_dir);
+    return 1;
+}
+
+/* Fill in a Unix socket address; returns 0 if the path is too long */
+int make_socket_address(const char *path, struct sockaddr_un *address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        printf("Error: Socket path too long: '%s'\n", path);
+        return 0;
+    }
+    strcpy(address->sun_path, path);
+    return 1;
+}
+
+/* Scan a folder, reusing the previous result if the directory hasn't changed since */
+int cached_scan_folder(const char *folder_path, const ProgramConfig *config, FileEntry *files,
+                       FILE *log_fp, FILE *out) {
+    struct stat st;
+    int file_count;
+    int slot = 0;
+
+    if (stat(folder_path, &st) != 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&folder_cache_lock);
+    for (int i = 0; i < FOLDER_CACHE_SIZE; i++) {
+        FolderCacheEntry *entry = &folder_cache[i];
+        if (entry->files && strcmp(entry->folder, folder_path) == 0 &&
+            entry->mtime.tv_sec == st.st_mtim.tv_sec && entry->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+            memcpy(files, entry->files, entry->file_count * sizeof(FileEntry));
+            file_count = entry->file_count;
+            entry->last_used = ++folder_cache_clock;
+            pthread_mutex_unlock(&folder_cache_lock);
+            return file_count;
+        }
+    }
+    pthread_mutex_unlock(&folder_cache_lock);
+
+    /* Scan outside the lock; the mtime taken above makes a concurrent change show up as stale next time */
+    file_count = scan_folder(folder_path, config, files, log_fp, out);
+    if (file_count < 0) {
+        return -1;
+    }
+
+    FileEntry *copy = malloc((file_count > 0 ? file_count : 1) * sizeof(FileEntry));
+    if (!copy) {
+        return file_count;
+    }
+    memcpy(copy, files, file_count * sizeof(FileEntry));
+
+    /* Replace this folder's old entry, or else the least recently used one */
+    pthread_mutex_lock(&folder_cache_lock);
+    for (int i = 0; i < FOLDER_CACHE_SIZE; i++) {
+        if (strcmp(folder_cache[i].folder, folder_path) == 0) {
+            slot = i;
+            break;
+        }
+        if (folder_cache[i].last_used < folder_cache[slot].last_used) {
+            slot = i;
+        }
+    }
+    free(folder_cache[slot].files);
+    strncpy(folder_cache[slot].folder, folder_path, MAX_PATH - 1);
+    folder_cache[slot].folder[MAX_PATH - 1] = '\0';
+    folder_cache[slot].mtime = st.st_mtim;
+    folder_cache[slot].files = copy;
+    folder_cache[slot].file_count = file_count;
+    folder_cache[slot].last_used = ++folder_cache_clock;
+    pthread_mutex_unlock(&folder_cache_lock);
+
+    return file_count;
+}
+
+/* CLASSIFY <filename>: reply with the detected episode number and special flag */
+void handle_classify(char **args, int arg_count, const ProgramConfig *config, FILE *out) {
+    if (arg_count < 2) {
+        fprintf(out, "ERR usage: CLASSIFY<TAB>filename\n");
+        return;
+    }
+
+    const char *filename = args[1];
+    const char *slash = strrchr(filename, '/');
+    if (slash) filename = slash + 1;
+
+    if (!config->force_mode && !is_video_file(get_file_extension(filename))) {
+        fprintf(out, "ERR not a video file: %s\n", filename);
+        return;
+    }
+
+    int episode_num = config->use_custom_pattern
+                      ? extract_episode_number_custom(filename)
+                      : extract_episode_number(filename);
+    if (episode_num == 0) {
+        fprintf(out, "ERR no episode number found in '%s'\n", filename);
+        return;
+    }
+
+    fprintf(out, "%d\t%d\n", episode_num, is_special_episode(filename));
+    fprintf(out, "OK\n");
+}
+
+/*
+ * PLAN/APPLY <show> <folder> [destination] [filename]: list or perform the
+ * renames for a folder. An empty destination means in place; a filename
+ * restricts the request to that single file.
+ */
+void handle_plan(char **args, int arg_count, int apply, const ClientContext *ctx, FILE *out) {
+    const ProgramConfig *config = ctx->config;
+    char destination_path[MAX_PATH];
+    char specials_path[MAX_PATH];
+    FileEntry *files;
+    int file_count;
+
+    if (arg_count < 3 || !*args[1] || !*args[2]) {
+        fprintf(out, "ERR usage: %s<TAB>show<TAB>folder[<TAB>destination[<TAB>filename]]\n", args[0]);
+        return;
+    }
+
+    const char *show_name = args[1];
+    const char *folder_path = args[2];
+    const char *only_file = arg_count >= 5 && *args[4] ? args[4] : NULL;
+    if (only_file && strrchr(only_file, '/')) only_file = strrchr(only_file, '/') + 1;
+
+    strncpy(destination_path, arg_count >= 4 && *args[3] ? args[3] : folder_path, MAX_PATH - 1);
+    destination_path[MAX_PATH - 1] = '\0';
+    snprintf(specials_path, sizeof(specials_path), "%s/Specials", destination_path);
+
+    files = malloc((only_file ? 1 : MAX_FILES) * sizeof(FileEntry));
+    if (!files) {
+        fprintf(out, "ERR out of memory\n");
+        return;
+    }
+
+    /*
+     * APPLY holds the lock from the scan through the renames, so a second
+     * APPLY on the same folder plans against what the first one left behind
+     */
+    int exclusive = apply && !config->dry_run;
+    if (exclusive) {
+        pthread_mutex_lock(&apply_lock);
+    }
+
+    if (only_file) {
+        /* A single file is classified on its own; no need to scan (or re-cache) the whole folder */
+        file_count = classify_file(folder_path, only_file, config, files, ctx->log_fp, out);
+    } else {
+        file_count = cached_scan_folder(folder_path, config, files, ctx->log_fp, out);
+        if (file_count < 0) {
+            fprintf(out, "ERR unable to open directory '%s': %s\n", folder_path, strerror(errno));
+            if (exclusive) {
+                pthread_mutex_unlock(&apply_lock);
+            }
+            free(files);
+            return;
+        }
+    }
+
+    if (file_count == 0) {
+        fprintf(out, "ERR no suitable files found\n");
+        if (exclusive) {
+            pthread_mutex_unlock(&apply_lock);
+        }
+        free(files);
+        return;
+    }
+
+    assign_new_names(files, file_count, show_name);
+    qsort(files, file_count, sizeof(FileEntry), compare_files);
+
+    /* A server started with -d only ever reports the plan, even for APPLY */
+    if (!exclusive) {
+        for (int i = 0; i < file_count; i++) {
+            fprintf(out, "%s\t%s%s\n", files[i].original_name,
+                    files[i].is_special ? "Specials/" : "", files[i].new_name);
+        }
+        if (apply) {
+            fprintf(out, "OK %d (dry run, no files were modified)\n", file_count);
+        } else {
+            fprintf(out, "OK %d\n", file_count);
+        }
+        free(files);
+        return;
+    }
+
+    ApplyStats stats;
+    if (ctx->log_fp) {
+        fprintf(ctx->log_fp, "[INFO] APPLY '%s': '%s' -> '%s'\n", show_name, folder_path, destination_path);
+    }
+    int applied = apply_files(files, file_count, folder_path, destination_path, specials_path,
+                              config, ctx->log_fp, out, &stats);
+    if (applied) {
+        report_throughput(&stats, config, "", out, ctx->log_fp);
+    }
+    if (ctx->log_fp) {
+        fflush(ctx->log_fp);
+    }
+    pthread_mutex_unlock(&apply_lock);
+
+    if (!applied) {
+        fprintf(out, "ERR failed to create destination directory '%s'\n", destination_path);
+    } else if (stats.success_count == file_count) {
+        fprintf(out, "OK %d/%d\n", stats.success_count, file_count);
+    } else {
+        fprintf(out, "ERR %d of %d files failed\n", file_count - stats.success_count, file_count);
+    }
+    free(files);
 }
 
-/* Extract episode number from various filename formats */
-int extract_episode_number(const char *filename) {
-    regex_t regex;
-    regmatch_t matches[2];
-    char episode_str[10] = {0};
-
-    /* Common episode number patterns */
-    const char *patterns[] = {
-        "Episode[ ]*([0-9]{1,3})",         /* Episode 1, Episode 12 */
-        "Ep[ ]*([0-9]{1,3})",              /* Ep 1, Ep12 */
-        "E([0-9]{1,3})([^0-9]|$)",         /* E01, E12 */
-        "-[ ]*([0-9]{1,3})([^0-9]|$)",     /* - 01, -12 */
-        "S[0-9]+[ ]*-[ ]*([0-9]{1,3})",    /* S2 - 10 */
-        "S[0-9]+[ ]+([0-9]{1,3})",         /* S2 08 */
-        "SP[ ]*([0-9]{1,3})",              /* SP01, SP 3 (for specials) */
-        " ([0-9]{1,2})[^0-9]"              /* Fallback: isolated numbers */
-    };
+/* Read tab-separated request lines from one client until it disconnects */
+void *handle_client(void *arg) {
+    ClientContext *ctx = arg;
+    FILE *in = fdopen(ctx->fd, "r");
+    int out_fd = dup(ctx->fd);
+    FILE *out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    char *line = NULL;
+    size_t line_size = 0;
 
-    /* Try each pattern until we find a match */
-    for (int i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
-        if (regcomp(&regex, patterns[i], REG_EXTENDED) != 0) {
-            continue;
-        }
+    if (!in || !out) {
+        if (in) fclose(in); else close(ctx->fd);
+        if (out) fclose(out); else if (out_fd >= 0) close(out_fd);
+        free(ctx);
+        return NULL;
+    }
 
-        if (regexec(&regex, filename, 2, matches, 0) == 0) {
-            int length = matches[1].rm_eo - matches[1].rm_so;
-            if (length < sizeof(episode_str)) {
-                strncpy(episode_str, filename + matches[1].rm_so, length);
-                episode_str[length] = '\0';
-                regfree(&regex);
+    while (getline(&line, &line_size, in) > 0) {
+        char *args[MAX_REQUEST_ARGS];
+        int arg_count = 0;
+        char *cursor = line;
 
-                /* Pad single digits with leading zero */
-                if (strlen(episode_str) == 1) {
-                    char padded_episode_str[3] = {'0', episode_str[0], '\0'};
-                    return atoi(padded_episode_str);
-                }
-                return atoi(episode_str);
-            }
+        line[strcspn(line, "\r\n")] = '\0';
+        if (*line == '\0') continue;
+        while (cursor && arg_count < MAX_REQUEST_ARGS) {
+            args[arg_count++] = strsep(&cursor, "\t");
         }
-        regfree(&regex);
-    }
-    
-    /* Fallback: look for isolated 2-digit numbers */
-    for (size_t i = 0; i < strlen(filename) - 1; i++) {
-        if (isdigit(filename[i]) && isdigit(filename[i + 1])) {
-            /* Make sure it's not part of a larger number */
-            if ((i == 0 || !isdigit(filename[i - 1])) &&
-                (i + 2 >= strlen(filename) || !isdigit(filename[i + 2]))) {
-                char num[3] = {filename[i], filename[i + 1], '\0'};
-                return atoi(num);
-            }
+
+        if (strcasecmp(args[0], "CLASSIFY") == 0) {
+            handle_classify(args, arg_count, ctx->config, out);
+        } else if (strcasecmp(args[0], "PLAN") == 0) {
+            handle_plan(args, arg_count, 0, ctx, out);
+        } else if (strcasecmp(args[0], "APPLY") == 0) {
+            handle_plan(args, arg_count, 1, ctx, out);
+        } else if (strcasecmp(args[0], "PING") == 0) {
+            fprintf(out, "OK %s\n", VERSION);
+        } else {
+            fprintf(out, "ERR unknown command: %s\n", args[0]);
         }
+        fflush(out);
     }
-    return 0; /* No episode number found */
+
+    free(line);
+    fclose(in);
+    fclose(out);
+    free(ctx);
+    return NULL;
 }
 
-/* Create directory if it doesn't exist */
-int create_directory(const char *path) {
-    struct stat st = {0};
-    if (stat(path, &st) == -1) {
-        #ifdef _WIN32
-        if (mkdir(path) != 0) {
-            printf("Error creating directory '%s': %s\n", path, strerror(errno));
-            return 0;
-        }
-        #else
-        if (mkdir(path, 0755) != 0) {
-            printf("Error creating directory '%s': %s\n", path, strerror(errno));
-            return 0;
-        }
-        #endif
+/* Remove the socket and exit on SIGINT/SIGTERM */
+void handle_shutdown_signal(int signum) {
+    unlink(serve_socket_path);
+    _exit(0);
+}
+
+/* Listen on a Unix socket and answer CLASSIFY/PLAN/APPLY requests, one thread per client */
+int serve(const ProgramConfig *config, FILE *log_fp) {
+    struct sockaddr_un address;
+    int listen_fd;
+
+    /* Compile patterns up front so the first client doesn't pay for it */
+    pthread_once(&builtin_patterns_once, compile_builtin_patterns);
+    if (config->use_custom_pattern && !custom_pattern_valid()) {
+        printf("Error compiling custom pattern: %s\n", config->custom_pattern);
         return 1;
     }
-    return 1; /* Directory already exists */
-}
 
-/* Copy a file from source to destination */
-int copy_file(const char *source, const char *destination) {
-    FILE *src, *dst;
-    char buffer[4096];
-    size_t bytes_read;
-    
-    src = fopen(source, "rb");
-    if (!src) {
-        printf("Error opening source file '%s': %s\n", source, strerror(errno));
-        return 0;
+    if (!make_socket_address(config->socket_path, &address)) {
+        return 1;
     }
-    
-    dst = fopen(destination, "wb");
-    if (!dst) {
-        printf("Error opening destination file '%s': %s\n", destination, strerror(errno));
-        fclose(src);
-        return 0;
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        printf("Error creating socket: %s\n", strerror(errno));
+        return 1;
     }
-    
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), src)) > 0) {
-        if (fwrite(buffer, 1, bytes_read, dst) != bytes_read) {
-            printf("Error writing to destination file '%s': %s\n", destination, strerror(errno));
-            fclose(src);
-            fclose(dst);
-            return 0;
+
+    /* Only the owner may connect */
+    mode_t old_umask = umask(0077);
+    int bound = bind(listen_fd, (struct sockaddr *)&address, sizeof(address));
+    if (bound != 0 && errno == EADDRINUSE) {
+        /* A leftover socket from a crashed server can be replaced; a live one (or any other file) can't */
+        struct stat st;
+        int probe = -1;
+        if (lstat(config->socket_path, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+            errno = ENOTSOCK;
+        } else if ((probe = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0 &&
+                   connect(probe, (struct sockaddr *)&address, sizeof(address)) != 0 &&
+                   errno == ECONNREFUSED) {
+            unlink(config->socket_path);
+            bound = bind(listen_fd, (struct sockaddr *)&address, sizeof(address));
+        } else {
+            errno = EADDRINUSE;
         }
+        if (probe >= 0) close(probe);
     }
-    
-    fclose(src);
-    fclose(dst);
+    umask(old_umask);
+
+    if (bound != 0 || listen(listen_fd, SOMAXCONN) != 0) {
+        printf("Error listening on '%s': %s\n", config->socket_path, strerror(errno));
+        close(listen_fd);
+        return 1;
+    }
+
+    strcpy(serve_socket_path, config->socket_path);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_shutdown_signal);
+    signal(SIGTERM, handle_shutdown_signal);
+
+    printf("ReNamed v%s serving on '%s'\n", VERSION, config->socket_path);
+    if (log_fp) {
+        fprintf(log_fp, "[INFO] Serving on '%s'\n", config->socket_path);
+        fflush(log_fp);
+    }
+    fflush(stdout);
+
+    while (1) {
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            printf("Error accepting connection: %s\n", strerror(errno));
+            break;
+        }
+
+        ClientContext *ctx = malloc(sizeof(ClientContext));
+        pthread_t thread;
+        if (!ctx) {
+            close(client_fd);
+            continue;
+        }
+        ctx->fd = client_fd;
+        ctx->config = config;
+        ctx->log_fp = log_fp;
+        if (pthread_create(&thread, NULL, handle_client, ctx) != 0) {
+            printf("Error starting client thread: %s\n", strerror(errno));
+            close(client_fd);
+            free(ctx);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listen_fd);
+    unlink(config->socket_path);
     return 1;
 }
 
-/* Log operation to file */
-void log_operation(FILE *log_file, const char *action, const char *old_path, const char *new_path, int success) {
-    time_t now;
-    struct tm *timeinfo;
-    char timestamp[20];
-    
-    time(&now);
-    timeinfo = localtime(&now);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", timeinfo);
-    
-    fprintf(log_file, "[%s] %s: %s -> %s [%s]\n", 
-            timestamp, 
-            action, 
-            old_path, 
-            new_path, 
-            success ? "SUCCESS" : "FAILED");
-}
+/* Send one request (arguments joined with tabs) to a running server and print the reply */
+int run_client(const ProgramConfig *config, int argc, char *argv[]) {
+    struct sockaddr_un address;
+    char buffer[4096];
+    char current_line[MAX_PATH * 2];
+    char last_line[MAX_PATH * 2] = {0};
+    size_t current_length = 0;
+    int fd;
+    FILE *out;
 
-/* Compare function for sorting files */
-int compare_files(const void *a, const void *b) {
-    FileEntry *fileA = (FileEntry *)a;
-    FileEntry *fileB = (FileEntry *)b;
-    
-    /* Group regular episodes before specials */
-    if (fileA->is_special != fileB->is_special) {
-        return fileA->is_special - fileB->is_special;
+    /* Allow an explicit "--" separator before the request */
+    if (argc > 0 && strcmp(argv[0], "--") == 0) {
+        argc--;
+        argv++;
+    }
+    if (argc == 0) {
+        printf("Usage: --client [--socket=<path>] COMMAND [ARGS...]\n");
+        return 1;
+    }
+    if (!make_socket_address(config->socket_path, &address)) {
+        return 1;
     }
-    
-    /* Sort by episode number */
-    return fileA->episode_number - fileB->episode_number;
-}
 
-/* Display version information */
-void print_version() {
-    printf("ReNamed - Automatic Episode Renamer v%s\n", VERSION);
-    printf("Repository: %s\n", REPO_URL);
-    printf("\nA simple tool to rename and organize TV show episodes.\n");
-}
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        printf("Error connecting to '%s': %s\n", config->socket_path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return 1;
+    }
 
-/* Display usage information */
-void print_usage(char *program_name) {
-    printf("Usage: %s [OPTIONS]\n\n", program_name);
-    printf("Options:\n");
-    printf("  -v           Display version information\n");
-    printf("  -h           Display this help message\n");
-    printf("  -f           Force renaming of all file types (not just video files)\n");
-    printf("  -k           Keep original files\n");
-    printf("  -d           Dry run mode (only show what would happen, don't rename files)\n");
-    printf("  -p <path>    Specify custom output path for renamed files\n");
-    printf("  --log[=file] Create log file (default: renamed_log.txt)\n");
-    printf("  --pattern=<regex> Specify custom regex pattern for episode detection\n");
-    printf("               Example: --pattern='Season (\\d+)-Episode (\\d+)'\n\n");
-    printf("If no options are provided, the program runs in interactive mode.\n");
-}
+    out = fdopen(dup(fd), "w");
+    if (!out) {
+        printf("Error writing request: %s\n", strerror(errno));
+        close(fd);
+        return 1;
+    }
+    for (int i = 0; i < argc; i++) {
+        fprintf(out, "%s%s", i ? "\t" : "", argv[i]);
+    }
+    fprintf(out, "\n");
+    fclose(out);
+    shutdown(fd, SHUT_WR);
 
-/* Check if a file is a video file */
-int is_video_file(const char *extension) {
-    return (strcasecmp(extension, ".mp4") == 0 ||
-            strcasecmp(extension, ".mkv") == 0 ||
-            strcasecmp(extension, ".avi") == 0);
+    /* Echo the reply, remembering its last line for the exit status */
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, bytes_read, stdout);
+        for (ssize_t i = 0; i < bytes_read; i++) {
+            if (buffer[i] == '\n') {
+                current_line[current_length] = '\0';
+                strcpy(last_line, current_line);
+                current_length = 0;
+            } else if (current_length < sizeof(current_line) - 1) {
+                current_line[current_length++] = buffer[i];
+            }
+        }
+    }
+    close(fd);
+
+    return strncmp(last_line, "OK", 2) == 0 ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
@@ -295,11 +1683,19 @@ int main(int argc, char *argv[]) {
     static struct option long_options[] = {
         {"log",     optional_argument, 0,  'l' },
         {"pattern", required_argument, 0,  'r' },
+        {"direct-io", no_argument,     0,  'D' },
+        {"max-bandwidth", required_argument, 0, 'B' },
+        {"max-iops", required_argument, 0, 'I' },
+        {"idle",    no_argument,       0,  'N' },
+        {"executor", required_argument, 0, 'E' },
+        {"serve",   no_argument,       0,  'S' },
+        {"client",  no_argument,       0,  'C' },
+        {"socket",  required_argument, 0,  'U' },
         {0,         0,                 0,  0   }
     };
 
-    /* Use getopt for command line parsing */
-    while ((opt = getopt_long(argc, argv, "vhfkdp:", long_options, &option_index)) != -1) {
+    /* Use getopt for command line parsing; everything after --client is request data, not options */
+    while (!config.client_mode && (opt = getopt_long(argc, argv, "vhfkdp:", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'v':
                 print_version();
@@ -332,6 +1728,46 @@ int main(int argc, char *argv[]) {
                 strncpy(config.custom_pattern, optarg, MAX_PATTERN_LENGTH - 1);
                 config.custom_pattern[MAX_PATTERN_LENGTH - 1] = '\0';
                 break;
+            case 'D': /* --direct-io option */
+                config.direct_io = 1;
+                break;
+            case 'B': /* --max-bandwidth option */
+                config.max_bandwidth = parse_rate(optarg);
+                if (config.max_bandwidth == 0) {
+                    printf("Invalid bandwidth limit: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'I': /* --max-iops option */
+                config.max_iops = parse_count(optarg);
+                if (config.max_iops == 0) {
+                    printf("Invalid IOPS limit: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'N': /* --idle option */
+                config.idle_priority = 1;
+                break;
+            case 'E': /* --executor option */
+                if (strcmp(optarg, "uring") == 0) {
+                    config.use_uring = 1;
+                } else if (strcmp(optarg, "sync") == 0) {
+                    config.use_uring = 0;
+                } else {
+                    printf("Unknown executor: %s (expected 'sync' or 'uring')\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'S': /* --serve option */
+                config.serve_mode = 1;
+                break;
+            case 'C': /* --client option */
+                config.client_mode = 1;
+                break;
+            case 'U': /* --socket option */
+                strncpy(config.socket_path, optarg, MAX_PATH - 1);
+                config.socket_path[MAX_PATH - 1] = '\0';
+                break;
             default:
                 printf("Unknown option: %c\n", opt);
                 print_usage(argv[0]);
@@ -339,6 +1775,17 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* Socket path for --serve/--client when --socket wasn't given */
+    if ((config.serve_mode || config.client_mode) && config.socket_path[0] == '\0' &&
+        !default_socket_path(config.socket_path, sizeof(config.socket_path), config.serve_mode)) {
+        return 1;
+    }
+
+    /* Client mode: the remaining arguments are the request */
+    if (config.client_mode) {
+        return run_client(&config, argc - optind, argv + optind);
+    }
+
     /* Parse non-option arguments for --log and --pattern */
     for (int i = optind; i < argc; i++) {
         if (strncmp(argv[i], "--log", 5) == 0) {
@@ -355,6 +1802,11 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* The custom pattern is compiled once, on first use */
+    if (config.use_custom_pattern) {
+        set_custom_pattern(config.custom_pattern);
+    }
+
     char show_name[MAX_PATH];
     char folder_path[MAX_PATH];
     char destination_path[MAX_PATH] = {0};
@@ -362,8 +1814,6 @@ int main(int argc, char *argv[]) {
     char confirm[10];
     FileEntry files[MAX_FILES];
     int file_count = 0;
-    DIR *dir;
-    struct dirent *entry;
     FILE *log_fp = NULL;
 
     /* Open log file if logging is enabled */
@@ -390,6 +1840,13 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* Server mode replaces the interactive prompts */
+    if (config.serve_mode) {
+        int result = serve(&config, log_fp);
+        if (log_fp) fclose(log_fp);
+        return result;
+    }
+
     /* Get show name from user */
     printf("Enter show name: ");
     if (fgets(show_name, sizeof(show_name), stdin) == NULL) {
@@ -459,7 +1916,7 @@ int main(int argc, char *argv[]) {
     }
 
     /* Create destination directory if it doesn't exist (even in dry run, for planning) */
-    if (!config.dry_run && !create_directory(destination_path)) {
+    if (!config.dry_run && !create_directory(destination_path, stdout)) {
         printf("Error: Failed to create destination directory '%s'\n", destination_path);
         if (log_fp) fclose(log_fp);
         return 1;
@@ -468,83 +1925,20 @@ int main(int argc, char *argv[]) {
     /* Create path for specials directory */
     snprintf(specials_path, sizeof(specials_path), "%s/Specials", destination_path);
 
-    /* Try to open directory */
-    dir = opendir(folder_path);
-    if (dir == NULL) {
-        printf("Error: Unable to open directory '%s': %s\n", folder_path, strerror(errno));
-        if (log_fp) fclose(log_fp);
-        return 1;
-    }
-
     /* Scan directory for files */
     if (config.force_mode) {
         printf("Scanning directory for all files (force mode)...\n");
     } else {
         printf("Scanning directory for video files...\n");
     }
-    
-    while ((entry = readdir(dir)) != NULL && file_count < MAX_FILES) {
-        /* Skip . and .. directories */
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-            continue;
-
-        /* Skip directories */
-        char full_path[MAX_PATH];
-        snprintf(full_path, sizeof(full_path), "%s/%s", folder_path, entry->d_name);
-
-        struct stat path_stat;
-        if (stat(full_path, &path_stat) != 0) {
-            printf("Warning: Cannot get stats for '%s': %s\n", entry->d_name, strerror(errno));
-            continue;
-        }
-        
-        if (!S_ISREG(path_stat.st_mode))
-            continue;
-
-        /* Get file extension */
-        const char *extension = get_file_extension(entry->d_name);
-
-        /* Skip non-video files unless force mode is enabled */
-        if (!config.force_mode && !is_video_file(extension))
-            continue;
-
-        /* Check if this is a special episode */
-        int special = is_special_episode(entry->d_name);
-        
-        /* Extract episode number using either custom or default patterns */
-        int episode_num;
-        if (config.use_custom_pattern) {
-            episode_num = extract_episode_number_custom(entry->d_name, config.custom_pattern);
-        } else {
-            episode_num = extract_episode_number(entry->d_name);
-        }
-
-        if (episode_num == 0) {
-            printf("Warning: No episode number found in '%s', skipping.\n", entry->d_name);
-            if (log_fp) {
-                fprintf(log_fp, "[WARNING] No episode number found in '%s', skipping.\n", entry->d_name);
-            }
-            continue;
-        }
-
-        /* Store file information */
-        strcpy(files[file_count].original_name, entry->d_name);
-        files[file_count].episode_number = episode_num;
-        files[file_count].is_special = special;
-
-        /* Generate new filename based on type */
-        if (special) {
-            snprintf(files[file_count].new_name, MAX_PATH, "%s - %02d - Special%s",
-                    show_name, episode_num, extension);
-        } else {
-            snprintf(files[file_count].new_name, MAX_PATH, "%s - %02d%s",
-                    show_name, episode_num, extension);
-        }
 
-        file_count++;
+    file_count = scan_folder(folder_path, &config, files, log_fp, stdout);
+    if (file_count < 0) {
+        printf("Error: Unable to open directory '%s': %s\n", folder_path, strerror(errno));
+        if (log_fp) fclose(log_fp);
+        return 1;
     }
-
-    closedir(dir);
+    assign_new_names(files, file_count, show_name);
 
     if (file_count == 0) {
         printf("No suitable files found in the directory.\n");
@@ -565,7 +1959,8 @@ int main(int argc, char *argv[]) {
     if (config.dry_run) {
         printf("Operation mode: DRY RUN - no actual changes will be made\n");
     } else if (config.keep_originals) {
-        printf("Operation mode: Copying files (keeping originals)\n");
+        printf("Operation mode: Copying files (keeping originals)%s\n",
+               config.direct_io ? " with direct I/O" : "");
     } else {
         printf("Operation mode: Moving/renaming files\n");
     }
@@ -573,6 +1968,18 @@ int main(int argc, char *argv[]) {
     if (config.use_log) {
         printf("Logging enabled: '%s'\n", config.log_file);
     }
+    if (config.max_bandwidth) {
+        printf("Bandwidth limit: %.1f MB/s\n", config.max_bandwidth / (1024.0 * 1024.0));
+    }
+    if (config.max_iops) {
+        printf("IOPS limit: %lu ops/s\n", config.max_iops);
+    }
+    if (config.idle_priority) {
+        printf("Running at idle I/O priority\n");
+    }
+    if (config.use_uring) {
+        printf("Executor: io_uring (batches of %d)\n", URING_QUEUE_DEPTH);
+    }
     if (config.use_custom_pattern) {
         printf("Using custom pattern: '%s'\n", config.custom_pattern);
     }
@@ -580,15 +1987,6 @@ int main(int argc, char *argv[]) {
     printf("\n%-70s -> %s\n", "Original Filename", "New Filename");
     printf("--------------------------------------------------------------------------------\n");
 
-    /* Check if any special episodes exist */
-    int has_special_episodes = 0;
-    for (int i = 0; i < file_count; i++) {
-        if (files[i].is_special) {
-            has_special_episodes = 1;
-            break;
-        }
-    }
-
     for (int i = 0; i < file_count; i++) {
         char orig_truncated[71] = {0};
         strncpy(orig_truncated, files[i].original_name, 70);
@@ -626,98 +2024,33 @@ int main(int argc, char *argv[]) {
     }
 
     if (strncasecmp(confirm, "yes", 3) == 0 || strncasecmp(confirm, "y", 1) == 0) {
-        /* Create destination directory if different from source */
-        if (strcmp(folder_path, destination_path) != 0) {
-            if (!create_directory(destination_path)) {
-                printf("Error: Failed to create destination directory '%s'\n", destination_path);
-                if (log_fp) {
-                    fprintf(log_fp, "[ERROR] Failed to create destination directory '%s'\n", destination_path);
-                    fclose(log_fp);
-                }
-                return 1;
-            }
-        }
-    
-        /* Create specials directory only if special episodes exist */
-        if (has_special_episodes) {
-            if (create_directory(specials_path)) {
-                printf("Created 'Specials' directory in '%s'.\n", destination_path);
-                if (log_fp) {
-                    fprintf(log_fp, "[INFO] Created 'Specials' directory in '%s'.\n", destination_path);
-                }
-            }
-        }
-        
         /* Perform renaming/copying */
-        int success_count = 0;
-        int special_count = 0;
-        int regular_count = 0;
-
-        for (int i = 0; i < file_count; i++) {
-            char old_path[MAX_PATH];
-            char new_path[MAX_PATH];
-
-            snprintf(old_path, sizeof(old_path), "%s/%s", folder_path, files[i].original_name);
-            
-            if (files[i].is_special) {
-                snprintf(new_path, sizeof(new_path), "%s/%s", specials_path, files[i].new_name);
-                special_count++;
-            } else {
-                snprintf(new_path, sizeof(new_path), "%s/%s", destination_path, files[i].new_name);
-                regular_count++;
-            }
-
-            if (config.keep_originals) {
-                /* Copy the file instead of renaming */
-                int success = copy_file(old_path, new_path);
-                if (success) {
-                    success_count++;
-                    printf("Copied '%s' to '%s'\n", files[i].original_name, new_path);
-                    if (log_fp) {
-                        log_operation(log_fp, "COPY", old_path, new_path, 1);
-                    }
-                } else {
-                    printf("Error copying '%s' to '%s'\n", files[i].original_name, new_path);
-                    if (log_fp) {
-                        log_operation(log_fp, "COPY", old_path, new_path, 0);
-                    }
-                }
-            } else {
-                /* Rename/move the file */
-                if (rename(old_path, new_path) == 0) {
-                    success_count++;
-                    printf("Renamed '%s' to '%s'\n", files[i].original_name, files[i].new_name);
-                    if (log_fp) {
-                        log_operation(log_fp, "RENAME", old_path, new_path, 1);
-                    }
-                } else {
-                    printf("Error renaming '%s' to '%s': %s\n", 
-                          files[i].original_name, 
-                          files[i].new_name,
-                          strerror(errno));
-                    if (log_fp) {
-                        log_operation(log_fp, "RENAME", old_path, new_path, 0);
-                    }
-                }
-            }
+        ApplyStats stats;
+        if (!apply_files(files, file_count, folder_path, destination_path, specials_path,
+                         &config, log_fp, stdout, &stats)) {
+            if (log_fp) fclose(log_fp);
+            return 1;
         }
 
         printf("\nOperation complete!\n");
         printf("- %d of %d files successfully %s\n", 
-               success_count, file_count, 
+               stats.success_count, file_count, 
                config.keep_originals ? "copied" : "renamed");
-        printf("- %d regular episodes\n", regular_count);
-        printf("- %d special episodes", special_count);
-        if (special_count > 0) {
+        printf("- %d regular episodes\n", stats.regular_count);
+        printf("- %d special episodes", stats.special_count);
+        if (stats.special_count > 0) {
             printf(" moved to Specials folder");
         }
         printf("\n");
         
         if (log_fp) {
             fprintf(log_fp, "[INFO] Operation complete! %d of %d files successfully %s.\n", 
-                   success_count, file_count, config.keep_originals ? "copied" : "renamed");
+                   stats.success_count, file_count, config.keep_originals ? "copied" : "renamed");
             fprintf(log_fp, "[INFO] %d regular episodes, %d special episodes.\n", 
-                   regular_count, special_count);
+                   stats.regular_count, stats.special_count);
+        }
+        report_throughput(&stats, &config, "- ", stdout, log_fp);
+        if (log_fp) {
             fprintf(log_fp, "----- ReNamed Session Ended -----\n\n");
         }
     } else {